@@ -21,6 +21,8 @@
 
 #include <cephfs/libcephfs.h>
 #include <fcntl.h>
+#include <stdlib.h>
+#include <string>
 #include <XrdSys/XrdSysError.hh>
 #include <XrdOuc/XrdOucString.hh>
 #include <XrdOuc/XrdOucStream.hh>
@@ -50,6 +52,8 @@ extern "C"
 CephfsOss::CephfsOss()
 {
   mCephMount = 0;
+  mCopyStreams = CephfsOssFile::CopyDefaultStreams;
+  mCopyEnabled = false;
 }
 
 CephfsOss::~CephfsOss()
@@ -129,6 +133,11 @@ CephfsOss::getCephConfiguration()
   mCephConfig["volume"] = "/";
   mCephConfig["id"] = "admin";
   mCephConfig["config"] = "/etc/ceph/ceph.conf";
+  mCephConfig["copystreams"] =
+    std::to_string(CephfsOssFile::CopyDefaultStreams);
+  mCephConfig["copy"] = "off";
+  mCopyStreams = CephfsOssFile::CopyDefaultStreams;
+  mCopyEnabled = false;
 
   Config.Attach(cfgFD);
   while ((var = Config.GetMyFirstWord())) {
@@ -150,6 +159,32 @@ CephfsOss::getCephConfiguration()
       continue;
     }
 
+    if (strcmp(var, "cephfs.copy") == 0) {
+      var = Config.GetWord();
+      if (!var || (strcmp(var, "on") && strcmp(var, "off"))) {
+        fprintf(stderr,"error: cephfs.copy must be 'on' or 'off'\n");
+        return false;
+      }
+      mCephConfig["copy"] = var;
+      mCopyEnabled = (strcmp(var, "on") == 0);
+      continue;
+    }
+
+    if (strcmp(var, "cephfs.copystreams") == 0) {
+      var = Config.GetWord();
+      char *end = 0;
+      long streams = (var ? strtol(var, &end, 10) : 0);
+      if (!var || *end || streams < 1 ||
+          streams > CephfsOssFile::CopyMaxStreams) {
+        fprintf(stderr,"error: cephfs.copystreams must be within 1..%d\n",
+                CephfsOssFile::CopyMaxStreams);
+        return false;
+      }
+      mCephConfig["copystreams"] = var;
+      mCopyStreams = streams;
+      continue;
+    }
+
     if (strncmp(var, "cephfs.", 7) == 0) {
       fprintf(stderr,"error: unknown cephfs configuration '%s'\n", var);
       return false;
@@ -228,7 +263,8 @@ CephfsOss::newDir(const char *tident)
 XrdOssDF *
 CephfsOss::newFile(const char *tident)
 {
-  return dynamic_cast<XrdOssDF *>(new CephfsOssFile(mCephMount));
+  return dynamic_cast<XrdOssDF *>(new CephfsOssFile(mCephMount, mCopyStreams,
+                                                    mCopyEnabled));
 }
 
 int
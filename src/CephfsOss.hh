@@ -69,6 +69,8 @@ private:
   std::map<std::string, std::string> mCephConfig;
   struct ceph_mount_info *mCephMount;
   const char *mConfigFN;
+  int mCopyStreams;
+  bool mCopyEnabled;
 };
 
 #endif /* __CEPHFS_OSS_HH__ */
@@ -21,6 +21,14 @@
 
 #include <thread>
 #include <future>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <string.h>
+#include <system_error>
+#include <stdlib.h>
+#include <fcntl.h>
 #include <cephfs/libcephfs.h>
 #include <private/XrdOss/XrdOssError.hh>
 #include <XrdOuc/XrdOucEnv.hh>
@@ -28,11 +36,19 @@
 #include "CephfsOssFile.hh"
 
 #define CEPHFS_ENV_PREFIX  "cephfs."
+#define CEPHFS_COPY_ALIGN  4096
+#define CEPHFS_COPY_BLOCK  (4 * 1024 * 1024)
+#define CEPHFS_COPY_MAX_BLOCK  (16 * 1024 * 1024)
+#define CEPHFS_COPY_BUDGET  (64 * 1024 * 1024)
 
-CephfsOssFile::CephfsOssFile(struct ceph_mount_info *cmount)
-  : mCephMount(cmount)
+CephfsOssFile::CephfsOssFile(struct ceph_mount_info *cmount, int copyStreams,
+                             bool copyEnabled)
+  : mCephMount(cmount),
+    mCopyStreams(copyStreams < 1 ? 1 :
+                 (copyStreams > CopyMaxStreams ? CopyMaxStreams : copyStreams)),
+    mCopyEnabled(copyEnabled)
 {
-  fd = 0;
+  fd = -1;
 }
 
 CephfsOssFile::~CephfsOssFile()
@@ -43,7 +59,12 @@ CephfsOssFile::~CephfsOssFile()
 int
 CephfsOssFile::Close(long long *retsz)
 {
-  return ceph_close(mCephMount, fd);
+  if (fd < 0)
+    return -XRDOSS_E8004;
+
+  int ret = ceph_close(mCephMount, fd);
+  fd = -1;
+  return ret;
 }
 
 int
@@ -53,6 +74,12 @@ CephfsOssFile::Open(const char *path, int flags, mode_t mode, XrdOucEnv &env)
   int stripe_count = (int) env.GetInt(CEPHFS_ENV_PREFIX "stripe_count");
   int object_size = (int) env.GetInt(CEPHFS_ENV_PREFIX  "object_size");
   char *data_pool = env.Get(CEPHFS_ENV_PREFIX "pool");
+  char *copy_from = env.Get(CEPHFS_ENV_PREFIX "copy_from");
+
+  if (copy_from && !mCopyEnabled)
+    return -ENOTSUP;
+  if (copy_from && (flags & O_ACCMODE) == O_RDONLY)
+    return -EBADF;
 
   if (stripe_unit < 0)
     stripe_count = 0;
@@ -64,7 +91,20 @@ CephfsOssFile::Open(const char *path, int flags, mode_t mode, XrdOucEnv &env)
   fd = ceph_open_layout(mCephMount, path, flags, mode, stripe_unit,
 			stripe_count, object_size, data_pool);
 
-  return (fd < 0 ? fd : XrdOssOK);
+  if (fd < 0)
+    return fd;
+
+  // server-side copy requested by the client: fill the new file from the
+  // source before any data is written through this handle
+  if (copy_from) {
+    int ret = CopyFrom(copy_from);
+    if (ret) {
+      Close();
+      return ret;
+    }
+  }
+
+  return XrdOssOK;
 }
 
 ssize_t
@@ -128,3 +168,153 @@ CephfsOssFile::Fsync()
 {
   return ceph_fsync(mCephMount, fd, 1);
 }
+
+int
+CephfsOssFile::Fctl(int cmd, int alen, const char *args, char **resp)
+{
+  if (cmd != Fctl_cephfsCopy)
+    return XrdOssDF::Fctl(cmd, alen, args, resp);
+
+  if (!args || alen <= 0)
+    return -EINVAL;
+
+  std::string srcPath(args, strnlen(args, alen));
+  return CopyFrom(srcPath.c_str());
+}
+
+int
+CephfsOssFile::CopyFrom(const char *srcPath)
+{
+  struct stat srcStat, dstStat;
+  int ret;
+
+  // the streams use this copy, so they never see a descriptor reset by Close
+  int dstFd = fd;
+  if (dstFd < 0)
+    return -XRDOSS_E8004;
+
+  int srcFd = ceph_open(mCephMount, srcPath, O_RDONLY, 0);
+  if (srcFd < 0)
+    return srcFd;
+
+  ret = ceph_fstat(mCephMount, srcFd, &srcStat);
+  if (ret == 0)
+    ret = ceph_fstat(mCephMount, dstFd, &dstStat);
+
+  if (ret == 0 && !S_ISREG(srcStat.st_mode))
+    ret = (S_ISDIR(srcStat.st_mode) ? -EISDIR : -EINVAL);
+
+  // copying a file onto itself would truncate the source before reading it
+  if (ret == 0 && srcStat.st_dev == dstStat.st_dev &&
+      srcStat.st_ino == dstStat.st_ino)
+    ret = -EINVAL;
+
+  // start from an empty destination, so blocks which are skipped as holes
+  // read back as zeros
+  if (ret == 0)
+    ret = ceph_ftruncate(mCephMount, dstFd, 0);
+
+  if (ret == 0) {
+    // blocks follow the object size of the source, capped to bound the memory
+    // of a copy; with striped layouts a block spreads over stripe_count objects
+    int objectSize = ceph_get_file_object_size(mCephMount, srcFd);
+    size_t blockSize = (objectSize > 0 ? objectSize : CEPHFS_COPY_BLOCK);
+    blockSize = std::min<size_t>(blockSize, CEPHFS_COPY_MAX_BLOCK);
+    blockSize = (blockSize + CEPHFS_COPY_ALIGN - 1) / CEPHFS_COPY_ALIGN
+      * CEPHFS_COPY_ALIGN;
+
+    ret = CopyRange(srcFd, dstFd, srcStat.st_size, blockSize);
+    if (ret == 0)
+      ret = ceph_ftruncate(mCephMount, dstFd, srcStat.st_size);
+
+    // don't leave a partial copy behind
+    if (ret != 0)
+      ceph_ftruncate(mCephMount, dstFd, 0);
+  }
+
+  int cret = ceph_close(mCephMount, srcFd);
+  return (ret ? ret : cret);
+}
+
+int
+CephfsOssFile::CopyRange(int srcFd, int dstFd, size_t len, size_t blockSize)
+{
+  if (!len)
+    return 0;
+
+  size_t nBlocks = (len + blockSize - 1) / blockSize;
+  // bound the buffer memory pinned by a single copy
+  size_t nStreams = std::min<size_t>(mCopyStreams, nBlocks);
+  nStreams = std::min<size_t>(nStreams, CEPHFS_COPY_BUDGET / blockSize);
+  nStreams = std::max<size_t>(nStreams, 1);
+  std::atomic<size_t> nextBlock(0);
+  std::atomic<int> retc(0);
+
+  // every stream claims the next free block, reads it into its own aligned
+  // buffer and writes it out, so reads and writes of different objects overlap
+  auto stream = [&]() {
+    void *buff = 0;
+
+    if (posix_memalign(&buff, CEPHFS_COPY_ALIGN, blockSize)) {
+      retc = -ENOMEM;
+      return;
+    }
+
+    size_t block;
+    while (!retc && (block = nextBlock++) < nBlocks) {
+      off_t pos = block * blockSize;
+      size_t blen = std::min<size_t>(blockSize, len - pos);
+      size_t nread = 0;
+
+      while (nread < blen) {
+        int rc = ceph_read(mCephMount, srcFd, (char *) buff + nread,
+                           blen - nread, pos + nread);
+        if (rc < 0) {
+          retc = rc;
+          break;
+        }
+        if (rc == 0)
+          break;
+        nread += rc;
+      }
+
+      // the source shrank since it was stat'ed
+      if (!retc && nread < blen)
+        retc = -EIO;
+      if (retc)
+        break;
+
+      // holes and zero blocks are not written, to keep sparse files sparse
+      const char *cbuff = (const char *) buff;
+      if (!cbuff[0] && !memcmp(cbuff, cbuff + 1, nread - 1))
+        continue;
+
+      size_t nwritten = 0;
+      while (!retc && nwritten < nread) {
+        int rc = ceph_write(mCephMount, dstFd, cbuff + nwritten,
+                            nread - nwritten, pos + nwritten);
+        if (rc <= 0) {
+          retc = (rc < 0 ? rc : -EIO);
+          break;
+        }
+        nwritten += rc;
+      }
+    }
+
+    free(buff);
+  };
+
+  std::vector<std::thread> streams;
+  try {
+    for (size_t i = 1; i < nStreams; i++)
+      streams.emplace_back(stream);
+  } catch (const std::system_error &e) {
+    retc = -e.code().value();
+  }
+
+  stream();
+  for (auto &t : streams)
+    t.join();
+
+  return retc;
+}
@@ -27,7 +27,17 @@
 class CephfsOssFile : public XrdOssDF
 {
 public:
-  CephfsOssFile(struct ceph_mount_info *cmount);
+  // plugin specific Fctl command: server-side copy of the file named in 'args'
+  // into this file. The source is a raw Cephfs path which is neither mapped
+  // nor authorized here - callers must map the name and check that the client
+  // may read the source before issuing it. The handle must not be closed while
+  // the copy is running.
+  static const int Fctl_cephfsCopy = 0x4345;
+  static const int CopyDefaultStreams = 8;
+  static const int CopyMaxStreams = 64;
+
+  CephfsOssFile(struct ceph_mount_info *cmount, int copyStreams,
+                bool copyEnabled);
   virtual ~CephfsOssFile();
   virtual int Open(const char *path, int flags, mode_t mode, XrdOucEnv &env);
   virtual int Close(long long *retsz=0);
@@ -42,9 +52,15 @@ public:
   virtual ssize_t Write(const void *buff, off_t offset, size_t blen);
   virtual int Fsync(void);
   virtual int getFD() { return fd; }
+  virtual int Fctl(int cmd, int alen, const char *args, char **resp=0);
+
+  int CopyFrom(const char *srcPath);
 
 private:
   struct ceph_mount_info *mCephMount;
+  int mCopyStreams;
+  bool mCopyEnabled;
+  int CopyRange(int srcFd, int dstFd, size_t len, size_t blockSize);
   int ReadAsync(XrdSfsAio *aio);
   int DoneReadAsync(XrdSfsAio *aio);
 };